@@ -6,59 +6,7 @@
 #include <boost/json.hpp>
 #include <boost/program_options.hpp>
 
-typedef int ExitStatus;
-
-class Context {
-public:
-  int argc;
-  const char **argv;
-};
-
-template <class... Ls> struct OptionLs {
-  static constexpr std::size_t size = sizeof...(Ls);
-};
-
-template <class... Options> struct Dispatcher {
-  template <class Option> static ExitStatus Dispatch(const Context &ctx) {
-    Option cmd(ctx);
-    return cmd.Run();
-  }
-};
-
-template <class Option> struct Dispatcher<OptionLs<Option>> {
-  static ExitStatus Dispatch(const Context &ctx, const std::string &name) {
-    if (std::string_view(name) == Option::OptionInfo::name) {
-      return Dispatcher<>::Dispatch<Option>(ctx);
-    } else {
-      std::cerr << "Unknown option: " << name << std::endl;
-      return EXIT_FAILURE;
-    }
-  }
-};
-
-template <class Option, class... Options>
-struct Dispatcher<OptionLs<Option, Options...>> {
-  static ExitStatus Dispatch(const Context &ctx, const std::string &name) {
-    if (name == Option::OptionInfo::name) {
-      return Dispatcher<>::Dispatch<Option>(ctx);
-    } else {
-      return Dispatcher<OptionLs<Options...>>::Dispatch(ctx, name);
-    }
-  }
-};
-
-template <class... Options> struct Info {
-  static constexpr std::size_t size = sizeof...(Options);
-};
-
-template <class... Options> struct Info<OptionLs<Options...>> {
-  static void Show() {
-    ((std::cout << "\n    " << Options::OptionInfo::name << ": "
-                << Options::OptionInfo::description),
-     ...);
-    std::cout << std::endl;
-  }
-};
+#include "s2sak_registry.h"
 
 template <class Option, class Suboptions> class With {
 public:
@@ -116,7 +64,7 @@ public:
       if (vm.count("help")) {
         std::cout << "Usage: " << ctx.argv[0] << " "
                   << Option::OptionInfo::name;
-        Info<Suboptions>::Show();
+        Registry<Suboptions>::Show();
         std::cout << desc << std::endl;
         return EXIT_SUCCESS;
       }
@@ -196,7 +144,7 @@ public:
                 boost::program_options::parsed_options &) {
     std::cout << "Foo option" << std::endl;
 
-    // Dispatcher<FooSubs>::Dispatch(ctx, ctx.argv[2]);
+    // Registry<FooSubs>::Dispatch(ctx, ctx.argv[2]);
     return EXIT_SUCCESS;
   }
 };
@@ -214,23 +162,13 @@ public:
     std::cout << "complete -c '" << cmd
               << "' -e -n '__fish_use_subcommand'\ncomplete -c '" << cmd
               << "' -f\n";
-    Completer<Options>::Definition(cmd);
+    Registry<Options>::Complete(cmd);
     std::cout << std::endl;
     return EXIT_SUCCESS;
   }
 
 private:
   const char *cmd;
-
-  template <class... Options> struct Completer;
-  template <class... Options> struct Completer<OptionLs<Options...>> {
-    static void Definition(const char *cmd) {
-      ((std::cout << "complete -c " << cmd << " -n '__fish_use_subcommand' -a '"
-                  << Options::OptionInfo::name << "' -d '"
-                  << Options::OptionInfo::description << "'\n"),
-       ...);
-    }
-  };
 };
 
 class HelpOption {
@@ -244,7 +182,7 @@ public:
 
   ExitStatus Run() {
     std::cout << "Usage: " << ctx.argv[0] << " [option]\n";
-    Info<Options>::Show();
+    Registry<Options>::Show();
     return EXIT_SUCCESS;
   }
 
@@ -255,5 +193,5 @@ private:
 int main(int argc, const char *argv[]) {
   if (argc < 2) { return HelpOption{Context{argc, argv}}.Run(); }
 
-  return Dispatcher<Options>::Dispatch(Context{argc, argv}, argv[1]);
+  return Registry<Options>::Dispatch(Context{argc, argv}, argv[1]);
 }
@@ -0,0 +1,738 @@
+#include <iomanip>
+#include <regex>
+
+#include <spawn.h>
+#include <sys/wait.h>
+
+#include "s2sak.cc"
+
+// The libpq calls that build a result in memory. s2sak never needs them, so
+// they are resolved here rather than in its Libpq table.
+#define S2SAK_BENCH_LIBPQ_SYMBOLS(X) \
+  X(PQmakeEmptyPGresult)             \
+  X(PQsetResultAttrs)                \
+  X(PQsetvalue)
+
+struct BenchLibpq : Client<BenchLibpq> {
+  S2SAK_BENCH_LIBPQ_SYMBOLS(S2SAK_CLIENT_SLOT)
+
+#ifndef S2SAK_LINK_CLIENTS
+  static constexpr const char *name = Libpq::name;
+  static constexpr auto &files = Libpq::files;
+
+  static void Resolve(void *handle) {
+    S2SAK_BENCH_LIBPQ_SYMBOLS(S2SAK_CLIENT_BIND)
+  }
+#endif
+};
+
+#define S2SAK_BENCH_LIBPQ_THUNK(name) S2SAK_CLIENT_THUNK(BenchLibpq, name)
+S2SAK_BENCH_LIBPQ_SYMBOLS(S2SAK_BENCH_LIBPQ_THUNK)
+
+// s2sak.cc befriends Bench so the benchmarks can reach the option internals
+// they time.
+struct Bench {
+  using Trie = DjTestNamesOption::Trie;
+  using Handler = MqOption::Handler;
+
+  static std::vector<Handler> Handlers(MYSQL_FIELD *fields,
+                                       unsigned int num_fields) {
+    return MqOption::Handlers(fields, num_fields);
+  }
+
+  static void WriteRow(MqOption &option,
+                       MYSQL_ROW row,
+                       unsigned long *lengths,
+                       MYSQL_FIELD *fields,
+                       const std::vector<Handler> &handlers,
+                       std::string_view tag = {}) {
+    option.WriteRow(row, lengths, fields, handlers, tag);
+  }
+
+  static ExitStatus Finish(MqOption &option) { return option.Finish(); }
+
+  static void PrettyPrint(DemandPayloadOption &option,
+                          Sink &sink,
+                          const boost::json::value &root) {
+    option.PrettyPrint(sink, root);
+  }
+};
+
+static volatile std::size_t blackhole;
+
+template <class F> static double Measure(F &&f) {
+  using clock = std::chrono::steady_clock;
+
+  for (int i = 0; i < 16; ++i) f();
+
+  std::size_t iterations = 0;
+  clock::time_point start = clock::now(), now;
+  do {
+    for (int i = 0; i < 64; ++i) f();
+    iterations += 64;
+    now = clock::now();
+  } while (now - start < std::chrono::milliseconds{200});
+
+  return static_cast<double>(
+             std::chrono::duration_cast<std::chrono::nanoseconds>(now - start)
+                 .count()) /
+         static_cast<double>(iterations);
+}
+
+// Results are kept for --json and --baseline; the table goes to stdout, or
+// to stderr when the JSON does.
+class Suite {
+public:
+  struct Result {
+    std::string name;
+    double ns;
+    std::size_t bytes;
+  };
+
+  int devnull;
+  std::string filter;
+  std::ostream *table = &std::cout;
+
+  Suite(int fd, std::string f) : devnull{fd}, filter{std::move(f)} {}
+
+  bool Selected(std::string_view name) const {
+    return name.find(filter) != std::string_view::npos;
+  }
+
+  template <class F>
+  void Run(const std::string &name, std::size_t bytes, F &&f) {
+    if (Selected(name)) Report(name, Measure(f), bytes);
+  }
+
+  void Report(const std::string &name, double ns, std::size_t bytes) {
+    results.push_back({name, ns, bytes});
+
+    std::ostream &os = *table;
+    os << std::left << std::setw(40) << name << std::right << std::setw(12)
+       << std::fixed << std::setprecision(1) << ns << " ns/op";
+    if (bytes)
+      os << std::setw(12) << static_cast<double>(bytes) / ns * 1e3 << " MB/s";
+    os << '\n';
+  }
+
+  // Output checks run ahead of the timings of the code they cover; a failed
+  // one fails the run.
+  void Check(const std::string &name, bool passed) {
+    if (passed) return;
+    std::cerr << "Check failed: " << name << std::endl;
+    failed = true;
+  }
+
+  bool Failed() const { return failed; }
+
+  // Runs f with stdout captured and returns what it wrote.
+  template <class F> std::string Capture(F &&f) {
+    std::cout.flush();
+    FILE *file = std::tmpfile();
+    if (!file) throw std::system_error(errno, std::generic_category());
+    int saved = dup(STDOUT_FILENO);
+    dup2(fileno(file), STDOUT_FILENO);
+    f();
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    std::string output;
+    std::rewind(file);
+    char buffer[4096];
+    for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file));)
+      output.append(buffer, n);
+    std::fclose(file);
+    return output;
+  }
+
+  // Runs f with stdout on /dev/null, for the options that write there.
+  template <class F> auto Quiet(F &&f) {
+    std::cout.flush();
+    int saved = dup(STDOUT_FILENO);
+    dup2(devnull, STDOUT_FILENO);
+    auto result = f();
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    return result;
+  }
+
+  void Json(std::ostream &os) const {
+    os << "{\"benchmarks\": [";
+    const char *separator = "\n";
+    for (const Result &result : results) {
+      std::string name;
+      JsonEscape::Append(name, result.name.data(), result.name.size());
+      os << separator << "  {\"name\": \"" << name
+         << "\", \"ns_per_op\": " << std::fixed << std::setprecision(1)
+         << result.ns << ", \"bytes_per_op\": " << result.bytes << '}';
+      separator = ",\n";
+    }
+    os << "\n]}\n";
+  }
+
+  // False if a benchmark got slower than its baseline by more than
+  // tolerance percent. Benchmarks missing on either side are skipped.
+  bool Compare(const boost::json::value &baseline, double tolerance) const {
+    std::unordered_map<std::string_view, double> base;
+    if (const boost::json::object *root = baseline.if_object())
+      if (const boost::json::value *list = root->if_contains("benchmarks"))
+        if (const boost::json::array *entries = list->if_array())
+          for (const boost::json::value &entry : *entries) {
+            const boost::json::object *object = entry.if_object();
+            if (!object) continue;
+            const boost::json::value *name = object->if_contains("name"),
+                                     *ns = object->if_contains("ns_per_op");
+            if (name && name->is_string() && ns && ns->is_number())
+              base[name->as_string()] = ns->to_number<double>();
+          }
+
+    std::ostream &os = *table;
+    os << '\n'
+       << std::left << std::setw(40) << "baseline" << std::right
+       << std::setw(12) << "base" << std::setw(12) << "current"
+       << std::setw(10) << "delta" << '\n';
+
+    bool passed = true;
+    for (const Result &result : results) {
+      auto it = base.find(result.name);
+      if (it == base.end() || it->second <= 0) continue;
+      double delta = (result.ns - it->second) / it->second * 100;
+      bool regressed = delta > tolerance;
+      passed &= !regressed;
+      os << std::left << std::setw(40) << result.name << std::right
+         << std::fixed << std::setprecision(1) << std::setw(12) << it->second
+         << std::setw(12) << result.ns << std::setw(9) << std::showpos
+         << delta << std::noshowpos << '%'
+         << (regressed ? "  REGRESSION" : "") << '\n';
+    }
+    return passed;
+  }
+
+private:
+  std::vector<Result> results;
+  bool failed = false;
+};
+
+static std::string EscapeInput(std::size_t size, std::size_t every) {
+  std::string s;
+  s.reserve(size);
+  for (std::size_t i = 0; i < size; ++i)
+    s += every && i % every == every - 1 ? '"'
+                                         : static_cast<char>('a' + i % 26);
+  return s;
+}
+
+static void BenchJsonEscape(Suite &suite) {
+  struct Input {
+    const char *name;
+    std::string data;
+  };
+
+  const Input inputs[] = {
+      {"short-clean", EscapeInput(48, 0)},
+      {"long-clean", EscapeInput(4096, 0)},
+      {"long-escaped", EscapeInput(4096, 64)},
+  };
+
+  std::vector<std::pair<const char *, JsonEscape::Scanner>> scanners{
+      {"scalar", JsonEscape::ScanScalar}};
+#if defined(__x86_64__)
+  scanners.emplace_back("sse2", JsonEscape::ScanSse2);
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    scanners.emplace_back("avx2", JsonEscape::ScanAvx2);
+#endif
+
+  for (const Input &input : inputs) {
+    for (const auto &[scanner_name, scanner] : scanners)
+      suite.Run(std::string{"json-escape/scan/"} + scanner_name + '/' +
+                    input.name,
+                input.data.size(),
+                [&input, scanner] {
+                  const char *p = input.data.data();
+                  std::size_t size = input.data.size(), i = 0, hits = 0;
+                  while (i < size) {
+                    i += scanner(p + i, size - i) + 1;
+                    ++hits;
+                  }
+                  blackhole = hits;
+                });
+
+    Sink sink{suite.devnull};
+    suite.Run(std::string{"json-escape/write/"} + input.name,
+              input.data.size(),
+              [&input, &sink] {
+                JsonEscape::Write(sink, input.data.data(), input.data.size());
+                sink.Settle();
+              });
+  }
+}
+
+// The std::regex extraction dj-test-names used before the hand-written
+// scanner, kept as the baseline.
+static std::size_t DjTestNamesRegex(const std::string &input) {
+  std::vector<std::vector<std::string>> results;
+
+  std::regex line_p(R"((test_\w+) \((\w+(?:\.\w+)+)\))");
+  std::regex word_p(R"((\w+))");
+
+  std::transform(
+      std::sregex_iterator{input.cbegin(), input.cend(), line_p},
+      std::sregex_iterator{},
+      std::back_inserter(results),
+      [&word_p](const std::smatch &match) {
+        std::vector<std::string> result;
+        const std::string smatch = match[2];
+        std::transform(
+            std::sregex_iterator{smatch.cbegin(), smatch.cend(), word_p},
+            std::sregex_iterator{},
+            std::back_inserter(result),
+            [](const std::smatch &m) { return m.str(); });
+        result.emplace_back(match[1]);
+        return result;
+      });
+
+  return results.size();
+}
+
+static std::string DjTestNamesInput(std::size_t lines) {
+  std::string s;
+  for (std::size_t i = 0; i < lines; ++i) {
+    s += "test_case_" + std::to_string(i) + " (apps.module" +
+         std::to_string(i % 97) + ".tests.test_views.ViewTests" +
+         std::to_string(i % 13) + ") ... ok\n";
+    if (i % 50 == 0) s += "----------------------------------------\n";
+  }
+  return s;
+}
+
+static void BenchDjTestNames(Suite &suite) {
+  struct Input {
+    const char *name;
+    std::string data;
+  };
+
+  const Input inputs[] = {
+      {"4k-lines", DjTestNamesInput(4000)},
+      {"400k-lines", DjTestNamesInput(400000)},
+  };
+
+  for (const Input &input : inputs) {
+    if (input.data.size() < (1 << 20))
+      suite.Run(std::string{"dj-test-names/regex/"} + input.name,
+                input.data.size(),
+                [&input] { blackhole = DjTestNamesRegex(input.data); });
+
+    std::vector<DjTestNamesOption::Match> matches;
+    suite.Run(std::string{"dj-test-names/scan/"} + input.name,
+              input.data.size(),
+              [&input, &matches] {
+                matches.clear();
+                DjTestNamesOption::ScanChunk(input.data, matches);
+                blackhole = matches.size();
+              });
+
+    suite.Run(
+        std::string{"dj-test-names/scan-threads/"} + input.name,
+        input.data.size(),
+        [&input] { blackhole = DjTestNamesOption::Scan(input.data).size(); });
+
+    // Building the completion trie and writing it out as the fish function
+    // is what --trie does after the scan.
+    matches = DjTestNamesOption::Scan(input.data);
+    suite.Run(std::string{"dj-test-names/trie/"} + input.name,
+              input.data.size(),
+              [&matches] {
+                Bench::Trie trie;
+                for (const DjTestNamesOption::Match &match : matches)
+                  trie.Insert(match);
+                blackhole = matches.size();
+              });
+
+    Bench::Trie trie;
+    for (const DjTestNamesOption::Match &match : matches) trie.Insert(match);
+    Sink sink{suite.devnull};
+    suite.Run(std::string{"dj-test-names/fish/"} + input.name,
+              input.data.size(),
+              [&trie, &sink] {
+                trie.Fish(sink);
+                sink.Flush();
+              });
+  }
+}
+
+static void BenchRegistry(Suite &suite) {
+  const char *names[] = {"pq", "complete", "demand-payload", "dem", "nope"};
+
+  for (const char *name : names) {
+    std::string_view key = name;
+    suite.Run(std::string{"registry/find/"} + name, key.size(), [key] {
+      blackhole = Registry<Options>::Find(key);
+    });
+  }
+}
+
+// Binary date and timestamp values against the text Postgres prints for
+// them: BC years and the infinity sentinels.
+static void CheckPqBinary(Suite &suite) {
+  if (!suite.Selected("pq/binary")) return;
+
+  auto decode = [&suite](Oid oid, std::int64_t value, std::size_t size) {
+    char bytes[8];
+    for (std::size_t i = 0; i < size; ++i)
+      bytes[i] = static_cast<char>(value >> (8 * (size - 1 - i)));
+    return suite.Capture([&] {
+      Sink sink{STDOUT_FILENO};
+      PqBinary::Decoder(oid)(sink, bytes, static_cast<int>(size), oid);
+    });
+  };
+
+  using namespace std::chrono;
+  const std::int64_t days =
+      (sys_days{year{-43} / 3 / 15} - sys_days{year{2000} / 1 / 1}).count();
+  const std::int64_t noon = days * 86400000000 + 43200000000;
+  constexpr std::int64_t int32_max = std::numeric_limits<std::int32_t>::max(),
+                         int32_min = std::numeric_limits<std::int32_t>::min(),
+                         int64_max = std::numeric_limits<std::int64_t>::max(),
+                         int64_min = std::numeric_limits<std::int64_t>::min();
+
+  const struct {
+    const char *name;
+    Oid oid;
+    std::int64_t value;
+    std::size_t size;
+    const char *text;
+  } cases[] = {
+      {"date-bc", 1082, days, 4, "\"0044-03-15 BC\""},
+      {"date-infinity", 1082, int32_max, 4, "\"infinity\""},
+      {"date-minus-infinity", 1082, int32_min, 4, "\"-infinity\""},
+      {"timestamp-bc", 1114, noon, 8, "\"0044-03-15 12:00:00 BC\""},
+      {"timestamptz-bc", 1184, noon, 8, "\"0044-03-15 12:00:00+00 BC\""},
+      {"timestamp-infinity", 1114, int64_max, 8, "\"infinity\""},
+      {"timestamp-minus-infinity", 1114, int64_min, 8, "\"-infinity\""},
+  };
+
+  for (const auto &test : cases)
+    suite.Check(std::string{"pq/binary/"} + test.name,
+                decode(test.oid, test.value, test.size) == test.text);
+}
+
+// A result shaped like a typical pq query, built in memory so that only the
+// formatting is timed.
+static PGresult *PqResult(int rows, std::size_t &bytes) {
+  PGresAttDesc attrs[] = {
+      {const_cast<char *>("id"), 0, 0, 0, 20, 8, -1},
+      {const_cast<char *>("name"), 0, 0, 0, 1043, -1, -1},
+      {const_cast<char *>("active"), 0, 0, 0, 16, 1, -1},
+      {const_cast<char *>("created_at"), 0, 0, 0, 1184, 8, -1},
+      {const_cast<char *>("payload"), 0, 0, 0, 114, -1, -1},
+  };
+
+  PGresult *res = BenchLibpq::PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK);
+  BenchLibpq::PQsetResultAttrs(res, 5, attrs);
+
+  bytes = 0;
+  for (int i = 0; i < rows; ++i) {
+    std::string values[] = {
+        std::to_string(1000000 + i),
+        "client \"" + std::to_string(i) + "\" of the north region",
+        i % 3 ? "t" : "f",
+        "2024-05-" + std::to_string(10 + i % 20) + " 12:34:56.789+00",
+        R"({"levels": [1, 2, 3], "tag": "x"})"};
+    for (int j = 0; j < 5; ++j) {
+      const std::string &value = values[j];
+      bytes += value.size();
+      BenchLibpq::PQsetvalue(res,
+                             i,
+                             j,
+                             const_cast<char *>(value.data()),
+                             static_cast<int>(value.size()));
+    }
+  }
+  return res;
+}
+
+static void BenchPq(Suite &suite) {
+  const std::string name = "pq/format/1k-rows";
+  if (!suite.Selected(name)) return;
+
+  std::size_t bytes;
+  PGresult *res = PqResult(1000, bytes);
+  const Context ctx{0, nullptr};
+
+  double ns = suite.Quiet([&ctx, res] {
+    PqOption option{ctx};
+    double result = Measure([&option, res] { option.Consume(res); });
+    option.Finish();
+    return result;
+  });
+  suite.Report(name, ns, bytes);
+
+  Libpq::PQclear(res);
+}
+
+static void BenchMq(Suite &suite) {
+  const std::string name = "mq/format/1k-rows";
+  if (!suite.Selected(name)) return;
+
+  MYSQL_FIELD fields[4]{};
+  const std::pair<const char *, enum_field_types> columns[] = {
+      {"id", MYSQL_TYPE_LONGLONG},
+      {"name", MYSQL_TYPE_VAR_STRING},
+      {"active", MYSQL_TYPE_BOOL},
+      {"created_at", MYSQL_TYPE_DATETIME},
+  };
+  for (std::size_t j = 0; j < 4; ++j) {
+    fields[j].name = const_cast<char *>(columns[j].first);
+    fields[j].type = columns[j].second;
+  }
+
+  // MYSQL_ROW is an array of column pointers with a parallel length array.
+  constexpr std::size_t rows = 1000;
+  std::vector<std::string> storage;
+  std::vector<char *> cells;
+  std::vector<unsigned long> lengths;
+  storage.reserve(rows * 4);
+  std::size_t bytes = 0;
+  for (std::size_t i = 0; i < rows; ++i) {
+    storage.push_back(std::to_string(1000000 + i));
+    storage.push_back("client \"" + std::to_string(i) +
+                      "\" of the north region");
+    storage.push_back(i % 3 ? "1" : "0");
+    storage.push_back("2024-05-" + std::to_string(10 + i % 20) +
+                      " 12:34:56");
+  }
+  for (std::string &value : storage) {
+    cells.push_back(value.data());
+    lengths.push_back(value.size());
+    bytes += value.size();
+  }
+
+  const std::vector<Bench::Handler> handlers = Bench::Handlers(fields, 4);
+  const Context ctx{0, nullptr};
+
+  // The rows must come out as a JSON array of objects, with and without the
+  // --dsn shard tag and with a NULL column.
+  for (std::string_view tag : {"", "  \"_shard\": \"db:3306/app\",\n"}) {
+    const std::string output = suite.Capture([&] {
+      MqOption option{ctx};
+      char *null_row[] = {cells[0], nullptr, cells[2], cells[3]};
+      Bench::WriteRow(option,
+                      cells.data(),
+                      lengths.data(),
+                      fields,
+                      handlers,
+                      tag);
+      Bench::WriteRow(option, null_row, lengths.data(), fields, handlers, tag);
+      Bench::Finish(option);
+    });
+    boost::json::error_code ec;
+    boost::json::value value = boost::json::parse(output, ec);
+    const boost::json::array *array = ec ? nullptr : value.if_array();
+    bool passed = array && array->size() == 2;
+    for (std::size_t i = 0; passed && i < array->size(); ++i) {
+      const boost::json::object *object = (*array)[i].if_object();
+      passed = object && object->size() == (tag.empty() ? 4 : 5);
+    }
+    suite.Check(tag.empty() ? "mq/format/json" : "mq/format/json-shard",
+                passed);
+  }
+
+  double ns = suite.Quiet([&] {
+    MqOption option{ctx};
+    return Measure([&] {
+      for (std::size_t i = 0; i < rows; ++i)
+        Bench::WriteRow(option,
+                        cells.data() + i * 4,
+                        lengths.data() + i * 4,
+                        fields,
+                        handlers);
+    });
+  });
+  suite.Report(name, ns, bytes);
+}
+
+// Objects and arrays nested depth levels deep, with width scalar members
+// at every level.
+static std::string DeepJson(std::size_t depth, std::size_t width) {
+  std::string s;
+  for (std::size_t d = 0; d < depth; ++d) {
+    bool object = d % 2 == 0;
+    s += object ? '{' : '[';
+    for (std::size_t i = 0; i < width; ++i) {
+      if (object) s += "\"key" + std::to_string(i) + "\": ";
+      s += i % 3 == 0   ? std::to_string(d * width + i)
+           : i % 3 == 1 ? "\"value " + std::to_string(i) + "\""
+                        : std::string{i % 2 ? "true" : "null"};
+      s += ", ";
+    }
+    if (object) s += "\"child\": ";
+  }
+  s += "{}";
+  for (std::size_t d = depth; d-- > 0;) s += d % 2 == 0 ? '}' : ']';
+  return s;
+}
+
+static void BenchDemandPayload(Suite &suite) {
+  struct Input {
+    const char *name;
+    std::string data;
+  };
+
+  const Input inputs[] = {
+      {"deep", DeepJson(256, 4)},
+      {"wide", DeepJson(2, 2000)},
+  };
+
+  const Context ctx{0, nullptr};
+  for (const Input &input : inputs) {
+    const std::string name =
+        std::string{"demand-payload/pretty-print/"} + input.name;
+    if (!suite.Selected(name)) continue;
+
+    const boost::json::value value = boost::json::parse(input.data);
+    DemandPayloadOption option{ctx};
+    Sink sink{suite.devnull};
+    suite.Run(name, input.data.size(), [&option, &sink, &value] {
+      Bench::PrettyPrint(option, sink, value);
+      sink.Flush();
+    });
+  }
+}
+
+#ifdef S2SAK_BENCH_BINARY
+// Spawn to exit of each subcommand. The unknown option stops the parsing
+// ones right after startup; help and complete take no options and just
+// print. update-aws is left out because it rewrites ~/.aws/credentials.
+static void BenchStartup(Suite &suite) {
+  const char *names[] = {"help",
+                         "complete",
+                         "dj-test-names",
+                         "pq",
+                         "mq",
+                         "npq",
+                         "e2e",
+                         "mock-assign",
+                         "demand-payload",
+                         "cache",
+                         "serve"};
+
+  setenv("S2SAK_NO_DAEMON", "1", 1);
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, suite.devnull, STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, suite.devnull, STDERR_FILENO);
+
+  for (const char *name : names) {
+    const char *argv[] = {
+        S2SAK_BENCH_BINARY, name, "--bench-startup", nullptr};
+    suite.Run(std::string{"startup/"} + name, 0, [&argv, &actions] {
+      pid_t pid;
+      int status = 0;
+      if (!posix_spawn(&pid,
+                       argv[0],
+                       &actions,
+                       nullptr,
+                       const_cast<char *const *>(argv),
+                       environ))
+        waitpid(pid, &status, 0);
+      blackhole = static_cast<std::size_t>(status);
+    });
+  }
+
+  posix_spawn_file_actions_destroy(&actions);
+}
+#endif
+
+int main(int argc, char *argv[]) {
+  boost::program_options::options_description desc{"s2sak_bench"};
+  desc.add_options() //
+      ("help,h", "Show help") //
+      ("filter,f",
+       boost::program_options::value<std::string>()->default_value(""),
+       "Run only the benchmarks whose name contains this") //
+      ("json,j",
+       boost::program_options::value<std::string>(),
+       "Write the results as JSON to FILE ('-' for stdout)") //
+      ("baseline,b",
+       boost::program_options::value<std::string>(),
+       "Compare against the JSON results in FILE and fail on regressions") //
+      ("tolerance,t",
+       boost::program_options::value<double>()->default_value(10),
+       "Percent slower than the baseline that counts as a regression");
+
+  boost::program_options::variables_map vm;
+  try {
+    boost::program_options::store(
+        boost::program_options::parse_command_line(argc, argv, desc), vm);
+  } catch (const boost::program_options::error &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  boost::program_options::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  std::optional<boost::json::value> baseline;
+  if (vm.count("baseline")) {
+    const std::string &filename = vm["baseline"].as<std::string>();
+    std::ifstream ifs{filename};
+    if (!ifs) {
+      std::cerr << "Failed to open baseline: " << filename << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    boost::json::error_code ec;
+    baseline = boost::json::parse(ss.str(), ec);
+    if (ec) {
+      std::cerr << "Invalid baseline: " << ec.message() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  Suite suite{open("/dev/null", O_WRONLY), vm["filter"].as<std::string>()};
+  if (suite.devnull < 0) {
+    std::cerr << "Failed to open /dev/null" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const std::string json =
+      vm.count("json") ? vm["json"].as<std::string>() : "";
+  if (json == "-") suite.table = &std::cerr;
+
+  BenchJsonEscape(suite);
+  BenchDjTestNames(suite);
+  BenchRegistry(suite);
+  CheckPqBinary(suite);
+  BenchPq(suite);
+  BenchMq(suite);
+  BenchDemandPayload(suite);
+#ifdef S2SAK_BENCH_BINARY
+  BenchStartup(suite);
+#endif
+
+  close(suite.devnull);
+
+  ExitStatus status = EXIT_SUCCESS;
+  if (json == "-") {
+    suite.Json(std::cout);
+  } else if (!json.empty()) {
+    std::ofstream ofs{json};
+    suite.Json(ofs);
+    if (!ofs.flush()) {
+      std::cerr << "Failed to write results: " << json << std::endl;
+      status = EXIT_FAILURE;
+    }
+  }
+
+  if (baseline && !suite.Compare(*baseline, vm["tolerance"].as<double>()))
+    status = EXIT_FAILURE;
+  if (suite.Failed()) status = EXIT_FAILURE;
+
+  return status;
+}
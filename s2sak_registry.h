@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <string_view>
+
+typedef int ExitStatus;
+
+class Context {
+public:
+  int argc;
+  const char **argv;
+};
+
+template <class... Ls> struct OptionLs {
+  static constexpr std::size_t size = sizeof...(Ls);
+};
+
+// FNV-1a over the name with the seed folded into the offset basis. The
+// final mix spreads the last character into the low bits the table masks;
+// without it "bar" and "baz" share a bucket under every seed.
+constexpr std::uint64_t RegistryHash(std::string_view name,
+                                     std::uint64_t seed) {
+  std::uint64_t hash = 0xcbf29ce484222325 ^ seed;
+  for (char c : name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccd;
+  return hash ^ (hash >> 33);
+}
+
+// The command table of an OptionLs, built at compile time from each
+// OptionInfo::name. A seed is searched so that every name lands in its own
+// bucket, so an exact lookup is one hash, one probe and one compare whatever
+// the number of commands. A unique prefix of a name also selects it; those
+// are resolved by binary search over the names in sorted order.
+//
+// An option with its own `Options` list is a nested table: dispatching is
+// left to the option, but completion descends into it.
+template <class... Options> struct Registry;
+
+template <class... Ls> struct Registry<OptionLs<Ls...>> {
+  static constexpr std::size_t size = sizeof...(Ls);
+
+  // Find results that are not an index.
+  static constexpr std::size_t unknown = size, ambiguous = size + 1;
+
+  static ExitStatus Dispatch(const Context &ctx, std::string_view name) {
+    static constexpr std::array<ExitStatus (*)(const Context &), size> runs{
+        &Run<Ls>...};
+
+    std::size_t index = Find(name);
+    if (index == unknown) {
+      std::cerr << "Unknown option: " << name << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (index == ambiguous) {
+      const Table &table = Get();
+      std::cerr << "Ambiguous option: " << name << " (";
+      const char *separator = "";
+      for (std::size_t i : table.sorted) {
+        if (!table.names[i].starts_with(name)) continue;
+        std::cerr << separator << table.names[i];
+        separator = ", ";
+      }
+      std::cerr << ")" << std::endl;
+      return EXIT_FAILURE;
+    }
+    return runs[index](ctx);
+  }
+
+  static std::size_t Find(std::string_view name) {
+    const Table &table = Get();
+
+    std::uint16_t slot =
+        table.slots[RegistryHash(name, table.seed) & (buckets - 1)];
+    if (slot && table.names[slot - 1u] == name) return slot - 1u;
+
+    if (name.empty()) return unknown;
+    const std::size_t *first = std::lower_bound(
+        table.sorted.begin(),
+        table.sorted.end(),
+        name,
+        [&table](std::size_t i, std::string_view key) {
+          return table.names[i] < key;
+        });
+    if (first == table.sorted.end() || !table.names[*first].starts_with(name))
+      return unknown;
+    if (first + 1 != table.sorted.end() &&
+        table.names[first[1]].starts_with(name))
+      return ambiguous;
+    return *first;
+  }
+
+  static std::string_view Name(std::size_t index) {
+    return Get().names[index];
+  }
+
+  static void Show() {
+    const Table &table = Get();
+    for (std::size_t i = 0; i < size; ++i)
+      std::cout << "\n    " << table.names[i] << ": "
+                << table.descriptions[i];
+    std::cout << std::endl;
+  }
+
+  // Fish completions for this table and, under their parent, for every
+  // nested one.
+  static void Complete(const char *cmd, std::string_view parent = {}) {
+    const Table &table = Get();
+    for (std::size_t i = 0; i < size; ++i) {
+      std::cout << "complete -c " << cmd << " -n '";
+      if (parent.empty()) std::cout << "__fish_use_subcommand";
+      else std::cout << "__fish_seen_subcommand_from " << parent;
+      std::cout << "' -a '" << table.names[i] << "' -d '"
+                << table.descriptions[i] << "'\n";
+    }
+    (Nested<Ls>(cmd), ...);
+  }
+
+private:
+  static constexpr std::size_t buckets = std::bit_ceil(size) * 4;
+  static constexpr std::uint64_t seed_max = 1 << 16;
+
+  static_assert(size < 0xffff, "too many commands for one table");
+
+  struct Table {
+    std::array<std::string_view, size> names, descriptions;
+    std::array<std::size_t, size> sorted;
+    std::array<std::uint16_t, buckets> slots;
+    std::uint64_t seed;
+  };
+
+  static consteval bool Distinct(const Table &table) {
+    for (std::size_t i = 1; i < size; ++i)
+      if (table.names[table.sorted[i - 1]] == table.names[table.sorted[i]])
+        return false;
+    return true;
+  }
+
+  static consteval Table Build() {
+    Table table{{Ls::OptionInfo::name...},
+                {Ls::OptionInfo::description...},
+                {},
+                {},
+                0};
+
+    std::iota(table.sorted.begin(), table.sorted.end(), std::size_t{0});
+    std::sort(table.sorted.begin(),
+              table.sorted.end(),
+              [&table](std::size_t a, std::size_t b) {
+                return table.names[a] < table.names[b];
+              });
+
+    // Duplicates collide under every seed; leave them to the static_assert.
+    if (!Distinct(table)) table.seed = seed_max;
+    for (; table.seed < seed_max; ++table.seed) {
+      table.slots = {};
+      bool collided = false;
+      for (std::size_t i = 0; i < size && !collided; ++i) {
+        std::uint16_t &slot =
+            table.slots[RegistryHash(table.names[i], table.seed) &
+                        (buckets - 1)];
+        collided = slot != 0;
+        slot = static_cast<std::uint16_t>(i + 1);
+      }
+      if (!collided) break;
+    }
+    return table;
+  }
+
+  // Built on first use rather than as a static member so that the table
+  // can list options that are still incomplete where it is named.
+  static const Table &Get() {
+    static constexpr Table table = Build();
+    static_assert(Distinct(table), "duplicate command name");
+    static_assert(!Distinct(table) || table.seed < seed_max,
+                  "command names collide");
+    return table;
+  }
+
+  template <class Option> static ExitStatus Run(const Context &ctx) {
+    Option cmd(ctx);
+    return cmd.Run();
+  }
+
+  template <class Option> static void Nested(const char *cmd) {
+    if constexpr (requires { typename Option::Options; })
+      Registry<typename Option::Options>::Complete(cmd,
+                                                   Option::OptionInfo::name);
+  }
+};